@@ -0,0 +1,545 @@
+#define _GNU_SOURCE // pthread_attr_setaffinity_np and cpu_set_t
+#include "alarm_scheduler.h"
+#include "errors.h"
+#include <sched.h>
+
+/*
+ * alarm_scheduler.c
+ *
+ * Implementation of the alarm scheduling engine behind alarm_scheduler.h.
+ * All state that used to be global (the alarm list, the display thread list
+ * and the mutex protecting them) lives in an alarm_scheduler_t, so that any
+ * number of independent instances can be created in one process. A display
+ * thread that is no longer needed is flagged as terminated and moved to the
+ * instance's list of terminated threads; the API call that terminated it
+ * joins it after releasing the mutex, so no display thread outlives the call
+ * that stopped it, nor alarm_scheduler_destroy.
+ */
+
+// Define a structure to store information about display alarm threads
+typedef struct display_alarm_info {
+  struct alarm_scheduler *scheduler; // Scheduler owning the thread
+  pthread_t thread;
+  int alarm_time_group;
+  int alarms_in_group;
+  int terminated;                  // Set when the thread must exit
+  pthread_cond_t condition;        // Condition variable for signaling
+  struct display_alarm_info *next; // Pointer to the next thread in the list
+} display_alarm_info_t;
+
+// Define a data structure to store information about each alarm
+typedef struct alarm_tag {
+  struct alarm_tag *link;
+  int alarm_id;
+  int seconds;
+  time_t time; /* seconds from EPOCH */
+  char message[ALARM_MESSAGE_MAX];
+} alarm_t;
+
+struct alarm_scheduler {
+  // Mutex for managing the alarm list and the display threads list
+  pthread_mutex_t alarm_mutex;
+
+  // Alarm list, sorted by alarm ID
+  alarm_t *alarm_list;
+
+  // List of display threads, and of terminated threads waiting to be joined
+  display_alarm_info_t *display_alarm_threads;
+  display_alarm_info_t *terminated_threads;
+
+  // Display callback
+  alarm_display_callback_t display;
+  void *user_data;
+
+  // CPUs the display threads of this instance are pinned to
+  int use_affinity;
+  cpu_set_t cpus;
+};
+
+// Calculate the Alarm_Time_Group_Number of an alarm period
+static int alarm_time_group(int seconds) { return (seconds + 4) / 5; }
+
+/*
+ * Report an event through the display callback. Called with alarm_mutex
+ * held.
+ */
+static void notify(alarm_scheduler_t *scheduler, alarm_event_type_t type,
+                   const alarm_t *alarm, int alarm_group, pthread_t thread) {
+  alarm_event_t event;
+
+  if (scheduler->display == NULL) {
+    return;
+  }
+  event.type = type;
+  event.alarm_id = alarm != NULL ? alarm->alarm_id : 0;
+  event.seconds = alarm != NULL ? alarm->seconds : 0;
+  event.alarm_group = alarm_group;
+  event.thread = thread;
+  event.time = time(NULL);
+  event.message = alarm != NULL ? alarm->message : NULL;
+  scheduler->display(&event, scheduler->user_data);
+}
+
+static void lock_scheduler(alarm_scheduler_t *scheduler) {
+  int status = pthread_mutex_lock(&scheduler->alarm_mutex);
+  if (status != 0) {
+    err_abort(status, "Lock mutex");
+  }
+}
+
+static void unlock_scheduler(alarm_scheduler_t *scheduler) {
+  int status = pthread_mutex_unlock(&scheduler->alarm_mutex);
+  if (status != 0) {
+    err_abort(status, "Unlock mutex");
+  }
+}
+
+/*
+ * Unlock alarm_mutex, then join and release the display threads terminated
+ * while it was held. Joining must happen outside the mutex, since a
+ * terminated thread needs it to wake up and exit.
+ */
+static void unlock_and_reap(alarm_scheduler_t *scheduler) {
+  int status;
+  display_alarm_info_t *terminated = scheduler->terminated_threads;
+  display_alarm_info_t *next;
+
+  scheduler->terminated_threads = NULL;
+  unlock_scheduler(scheduler);
+
+  while (terminated != NULL) {
+    next = terminated->next;
+    status = pthread_join(terminated->thread, NULL);
+    if (status != 0) {
+      err_abort(status, "Join display alarm thread");
+    }
+    pthread_cond_destroy(&terminated->condition);
+    free(terminated);
+    terminated = next;
+  }
+}
+
+/*
+ * The display alarm thread function that displays alarms in its group. It
+ * holds alarm_mutex except while waiting for the closest alarm of its group
+ * to expire, and rechecks the list whenever it is signaled.
+ */
+static void *display_alarm(void *arg) {
+  display_alarm_info_t *info = (display_alarm_info_t *)arg;
+  alarm_scheduler_t *scheduler = info->scheduler;
+  int alarm_group = info->alarm_time_group;
+
+  lock_scheduler(scheduler);
+
+  while (!info->terminated) {
+    // Variables to find the closest alarm for display
+    alarm_t *curr_alarm = scheduler->alarm_list;
+    alarm_t *closest_alarm = NULL;
+    time_t closest_expiration_time = 0;
+
+    // Iterate through the alarm list to find the closest alarm
+    while (curr_alarm != NULL) {
+      if (alarm_time_group(curr_alarm->seconds) == alarm_group) {
+        time_t expiration_time = curr_alarm->time + curr_alarm->seconds;
+        if (closest_alarm == NULL ||
+            expiration_time < closest_expiration_time) {
+          closest_alarm = curr_alarm;
+          closest_expiration_time = expiration_time;
+        }
+      }
+      curr_alarm = curr_alarm->link;
+    }
+
+    if (closest_alarm == NULL) {
+      // Nothing to display until an alarm is added to the group
+      pthread_cond_wait(&info->condition, &scheduler->alarm_mutex);
+      continue;
+    }
+
+    if (closest_expiration_time > time(NULL)) {
+      // Wait until the closest alarm expires, or until signaled to recheck
+      struct timespec sleep_time = {closest_expiration_time, 0};
+      pthread_cond_timedwait(&info->condition, &scheduler->alarm_mutex,
+                             &sleep_time);
+      continue;
+    }
+
+    // The closest alarm's time has expired, update its time and display it
+    closest_alarm->time = time(NULL);
+    notify(scheduler, ALARM_EVENT_DISPLAYED, closest_alarm, alarm_group,
+           pthread_self());
+  }
+
+  // The thread was terminated, its information is released once joined
+  unlock_scheduler(scheduler);
+
+  return NULL;
+}
+
+/*
+ * Find the display thread of a group, creating it if it does not exist, and
+ * count one more alarm in that group. *created is set when a new thread was
+ * started. Called with alarm_mutex held.
+ */
+static int attach_display_thread(alarm_scheduler_t *scheduler, int alarm_group,
+                                 display_alarm_info_t **thread_info,
+                                 int *created) {
+  int status;
+  pthread_attr_t attr;
+
+  // Check if a display alarm thread for this group exists
+  display_alarm_info_t *current = scheduler->display_alarm_threads;
+
+  *created = 0;
+  while (current != NULL) {
+    if (current->alarm_time_group == alarm_group) {
+      current->alarms_in_group = current->alarms_in_group + 1;
+      // Signal it to recheck its list for an earlier printing alarm
+      pthread_cond_signal(&current->condition);
+      *thread_info = current;
+      return 0; // Found an existing display alarm thread
+    }
+    current = current->next;
+  }
+
+  // If no existing thread is found, create a new one
+  display_alarm_info_t *new_thread_info =
+      (display_alarm_info_t *)malloc(sizeof(display_alarm_info_t));
+  if (new_thread_info == NULL) {
+    return ENOMEM;
+  }
+  // Set the alarm group number and number of alarms in the group
+  new_thread_info->scheduler = scheduler;
+  new_thread_info->alarm_time_group = alarm_group;
+  new_thread_info->alarms_in_group = 1;
+  new_thread_info->terminated = 0;
+  status = pthread_cond_init(&new_thread_info->condition, NULL);
+  if (status != 0) {
+    free(new_thread_info);
+    return status;
+  }
+
+  // Display threads run on the instance's CPUs
+  status = pthread_attr_init(&attr);
+  if (status == 0) {
+    if (scheduler->use_affinity) {
+      status = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t),
+                                           &scheduler->cpus);
+    }
+    if (status == 0) {
+      status = pthread_create(&new_thread_info->thread, &attr, display_alarm,
+                              new_thread_info);
+    }
+    pthread_attr_destroy(&attr);
+  }
+  if (status != 0) {
+    pthread_cond_destroy(&new_thread_info->condition);
+    free(new_thread_info);
+    return status;
+  }
+
+  // Add the new display thread at the beginning of list
+  new_thread_info->next = scheduler->display_alarm_threads;
+  scheduler->display_alarm_threads = new_thread_info;
+
+  *thread_info = new_thread_info;
+  *created = 1;
+  return 0;
+}
+
+/*
+ * Count one alarm less in a group, and terminate the group's display thread
+ * if it is no longer responsible for any alarms. Called with alarm_mutex
+ * held.
+ */
+static void detach_display_thread(alarm_scheduler_t *scheduler,
+                                  int alarm_group) {
+  display_alarm_info_t *prev = NULL;
+  display_alarm_info_t *current = scheduler->display_alarm_threads;
+
+  while (current != NULL) {
+    if (current->alarm_time_group == alarm_group) {
+      // Remove one alarm from group for replace or cancel
+      current->alarms_in_group = current->alarms_in_group - 1;
+      if (current->alarms_in_group == 0) {
+        // Move to the terminated list, to be joined once the mutex is released
+        if (prev == NULL) {
+          scheduler->display_alarm_threads = current->next;
+        } else {
+          prev->next = current->next;
+        }
+        current->next = scheduler->terminated_threads;
+        scheduler->terminated_threads = current;
+        current->terminated = 1;
+        notify(scheduler, ALARM_EVENT_THREAD_TERMINATED, NULL, alarm_group,
+               current->thread);
+      }
+      // Signal the thread to exit, or to recheck the list since one of its
+      // alarms was removed
+      pthread_cond_signal(&current->condition);
+      return;
+    }
+
+    prev = current;
+    current = current->next;
+  }
+}
+
+// Copy a message into an alarm, truncating it if necessary
+static void set_message(alarm_t *alarm, const char *message) {
+  snprintf(alarm->message, sizeof(alarm->message), "%s",
+           message != NULL ? message : "");
+}
+
+int alarm_scheduler_create(alarm_scheduler_t **scheduler,
+                           const alarm_scheduler_options_t *options) {
+  int status;
+  int i;
+  cpu_set_t allowed;
+  alarm_scheduler_t *new_scheduler;
+
+  new_scheduler = (alarm_scheduler_t *)calloc(1, sizeof(alarm_scheduler_t));
+  if (new_scheduler == NULL) {
+    return ENOMEM;
+  }
+
+  if (options != NULL) {
+    new_scheduler->display = options->display;
+    new_scheduler->user_data = options->user_data;
+
+    // Build the CPU set the instance's display threads are sharded onto
+    if (options->cpus != NULL) {
+      if (options->num_cpus <= 0) {
+        free(new_scheduler);
+        return EINVAL;
+      }
+      CPU_ZERO(&new_scheduler->cpus);
+      for (i = 0; i < options->num_cpus; i++) {
+        if (options->cpus[i] < 0 || options->cpus[i] >= CPU_SETSIZE) {
+          free(new_scheduler);
+          return EINVAL;
+        }
+        CPU_SET(options->cpus[i], &new_scheduler->cpus);
+      }
+
+      // Every requested CPU must be one the process is allowed to run on
+      if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+        status = errno;
+        free(new_scheduler);
+        return status;
+      }
+      CPU_AND(&allowed, &allowed, &new_scheduler->cpus);
+      if (!CPU_EQUAL(&allowed, &new_scheduler->cpus)) {
+        free(new_scheduler);
+        return EINVAL;
+      }
+      new_scheduler->use_affinity = 1;
+    }
+  }
+
+  status = pthread_mutex_init(&new_scheduler->alarm_mutex, NULL);
+  if (status != 0) {
+    free(new_scheduler);
+    return status;
+  }
+
+  *scheduler = new_scheduler;
+  return 0;
+}
+
+int alarm_scheduler_insert(alarm_scheduler_t *scheduler, int alarm_id,
+                           int seconds, const char *message) {
+  int status;
+  int created;
+  int alarm_group;
+  alarm_t **last, *next, *alarm;
+  display_alarm_info_t *thread_info;
+
+  if (alarm_id <= 0 || seconds <= 0) {
+    return EINVAL;
+  }
+
+  alarm = (alarm_t *)malloc(sizeof(alarm_t));
+  if (alarm == NULL) {
+    return ENOMEM;
+  }
+  alarm->alarm_id = alarm_id;
+  alarm->seconds = seconds;
+  set_message(alarm, message);
+  alarm_group = alarm_time_group(seconds);
+
+  lock_scheduler(scheduler);
+
+  // last is the header of list, next is the first element in list
+  last = &scheduler->alarm_list;
+  next = *last;
+
+  // Find the insertion point, keeping the list ordered by alarm ID
+  while (next != NULL && next->alarm_id < alarm_id) {
+    last = &next->link;
+    next = *last;
+  }
+  if (next != NULL && next->alarm_id == alarm_id) {
+    // An alarm with the same ID already exists, don't insert the new alarm
+    unlock_scheduler(scheduler);
+    free(alarm);
+    return EEXIST;
+  }
+
+  // Check for an existing or create a display thread before linking
+  status = attach_display_thread(scheduler, alarm_group, &thread_info,
+                                 &created);
+  if (status != 0) {
+    unlock_scheduler(scheduler);
+    free(alarm);
+    return status;
+  }
+
+  // Insert before next, which is NULL at the end of the list
+  alarm->link = next;
+  *last = alarm;
+  alarm->time = time(NULL);
+
+  notify(scheduler, ALARM_EVENT_INSERTED, alarm, alarm_group, pthread_self());
+  if (created) {
+    notify(scheduler, ALARM_EVENT_THREAD_CREATED, alarm, alarm_group,
+           thread_info->thread);
+  }
+
+  unlock_scheduler(scheduler);
+  return 0;
+}
+
+int alarm_scheduler_replace(alarm_scheduler_t *scheduler, int alarm_id,
+                            int seconds, const char *message) {
+  int status;
+  int created = 0;
+  int replaced_alarm_group, new_alarm_group;
+  alarm_t *alarm_to_replace;
+  display_alarm_info_t *thread_info = NULL;
+
+  if (alarm_id <= 0 || seconds <= 0) {
+    return EINVAL;
+  }
+
+  lock_scheduler(scheduler);
+
+  alarm_to_replace = scheduler->alarm_list;
+  while (alarm_to_replace != NULL && alarm_to_replace->alarm_id != alarm_id) {
+    alarm_to_replace = alarm_to_replace->link;
+  }
+  if (alarm_to_replace == NULL) {
+    unlock_scheduler(scheduler);
+    return ENOENT;
+  }
+
+  replaced_alarm_group = alarm_time_group(alarm_to_replace->seconds);
+  new_alarm_group = alarm_time_group(seconds);
+
+  // Get or create the display thread of the new group before modifying
+  if (replaced_alarm_group != new_alarm_group) {
+    status = attach_display_thread(scheduler, new_alarm_group, &thread_info,
+                                   &created);
+    if (status != 0) {
+      unlock_scheduler(scheduler);
+      return status;
+    }
+  }
+
+  // Replace the alarm's data with the received data
+  alarm_to_replace->seconds = seconds;
+  alarm_to_replace->time = time(NULL);
+  set_message(alarm_to_replace, message);
+
+  notify(scheduler, ALARM_EVENT_REPLACED, alarm_to_replace, new_alarm_group,
+         pthread_self());
+
+  if (replaced_alarm_group != new_alarm_group) {
+    // Check whether to remove the display thread of the original group
+    detach_display_thread(scheduler, replaced_alarm_group);
+    if (created) {
+      notify(scheduler, ALARM_EVENT_THREAD_CREATED, alarm_to_replace,
+             new_alarm_group, thread_info->thread);
+    }
+  } else {
+    // Same group, signal its thread to recheck the alarm's new period
+    thread_info = scheduler->display_alarm_threads;
+    while (thread_info != NULL &&
+           thread_info->alarm_time_group != new_alarm_group) {
+      thread_info = thread_info->next;
+    }
+    if (thread_info != NULL) {
+      pthread_cond_signal(&thread_info->condition);
+    }
+  }
+
+  unlock_and_reap(scheduler);
+  return 0;
+}
+
+int alarm_scheduler_cancel(alarm_scheduler_t *scheduler, int alarm_id) {
+  alarm_t **last, *curr;
+
+  if (alarm_id <= 0) {
+    return EINVAL;
+  }
+
+  lock_scheduler(scheduler);
+
+  last = &scheduler->alarm_list;
+  curr = *last;
+  while (curr != NULL && curr->alarm_id != alarm_id) {
+    last = &curr->link;
+    curr = *last;
+  }
+  if (curr == NULL) {
+    unlock_scheduler(scheduler);
+    return ENOENT;
+  }
+
+  // Remove the canceled alarm from the alarm list
+  *last = curr->link;
+  notify(scheduler, ALARM_EVENT_CANCELED, curr,
+         alarm_time_group(curr->seconds), pthread_self());
+
+  // Check for empty display thread group
+  detach_display_thread(scheduler, alarm_time_group(curr->seconds));
+  free(curr);
+
+  unlock_and_reap(scheduler);
+  return 0;
+}
+
+void alarm_scheduler_destroy(alarm_scheduler_t *scheduler) {
+  alarm_t *alarm;
+  display_alarm_info_t *current;
+
+  if (scheduler == NULL) {
+    return;
+  }
+
+  lock_scheduler(scheduler);
+
+  // Ask every display thread to exit, and queue it to be joined
+  while (scheduler->display_alarm_threads != NULL) {
+    current = scheduler->display_alarm_threads;
+    scheduler->display_alarm_threads = current->next;
+    current->next = scheduler->terminated_threads;
+    scheduler->terminated_threads = current;
+    current->terminated = 1;
+    pthread_cond_signal(&current->condition);
+  }
+
+  // Free the remaining alarms
+  while (scheduler->alarm_list != NULL) {
+    alarm = scheduler->alarm_list;
+    scheduler->alarm_list = alarm->link;
+    free(alarm);
+  }
+
+  // Join every display thread before releasing the scheduler
+  unlock_and_reap(scheduler);
+
+  pthread_mutex_destroy(&scheduler->alarm_mutex);
+  free(scheduler);
+}
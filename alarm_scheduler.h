@@ -0,0 +1,125 @@
+/*
+ * alarm_scheduler.h
+ *
+ * Public C API for the alarm scheduling engine. Each scheduler is an
+ * independent instance that owns its own alarm list, display threads and
+ * mutex, so several schedulers can run side by side in the same process.
+ */
+#ifndef ALARM_SCHEDULER_H
+#define ALARM_SCHEDULER_H
+
+#include <pthread.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum length of an alarm message, including the terminating NUL
+#define ALARM_MESSAGE_MAX 128
+
+// Opaque handle to a scheduler instance
+typedef struct alarm_scheduler alarm_scheduler_t;
+
+// Kinds of events reported through the display callback
+typedef enum {
+  ALARM_EVENT_INSERTED,          // Alarm added by alarm_scheduler_insert
+  ALARM_EVENT_REPLACED,          // Alarm updated by alarm_scheduler_replace
+  ALARM_EVENT_CANCELED,          // Alarm removed by alarm_scheduler_cancel
+  ALARM_EVENT_DISPLAYED,         // Alarm expired and displayed
+  ALARM_EVENT_THREAD_CREATED,    // Display thread started for a group
+  ALARM_EVENT_THREAD_TERMINATED, // Display thread stopped for a group
+} alarm_event_type_t;
+
+/*
+ * Information passed to the display callback for each event. The event and
+ * its message are only valid for the duration of the callback; copy the
+ * message to keep it, since the scheduler frees or overwrites it afterwards.
+ */
+typedef struct {
+  alarm_event_type_t type;
+  int alarm_id;        // Alarm concerned, 0 for ALARM_EVENT_THREAD_TERMINATED
+  int seconds;         // Alarm period in seconds
+  int alarm_group;     // Alarm_Time_Group_Number of the alarm or thread
+  pthread_t thread;    // Thread that handled the event
+  time_t time;         // Time at which the event happened
+  const char *message; // Alarm message, NULL for ALARM_EVENT_THREAD_TERMINATED
+} alarm_event_t;
+
+/*
+ * Display callback. It is invoked with the scheduler's mutex held, so
+ * callbacks of one instance never run concurrently, but the callback must
+ * not call back into the same scheduler.
+ */
+typedef void (*alarm_display_callback_t)(const alarm_event_t *event,
+                                         void *user_data);
+
+// Options used when creating a scheduler
+typedef struct {
+  alarm_display_callback_t display; // Event callback, may be NULL
+  void *user_data;                  // Passed unchanged to the callback
+  const int *cpus; // CPUs the display threads are pinned to, NULL for any
+  int num_cpus;    // Number of entries in cpus
+} alarm_scheduler_options_t;
+
+/**
+ * @brief Create a new, empty scheduler instance.
+ *
+ * @param scheduler Receives the handle of the new scheduler.
+ * @param options Callback and CPU affinity of the instance, may be NULL.
+ * @return 0 on success, EINVAL if cpus is non-NULL with num_cpus <= 0 or
+ * names a CPU the process cannot run on, ENOMEM if memory could not be
+ * allocated.
+ */
+int alarm_scheduler_create(alarm_scheduler_t **scheduler,
+                           const alarm_scheduler_options_t *options);
+
+/**
+ * @brief Insert an alarm into the scheduler, keeping the list ordered by ID.
+ *
+ * A display thread is created for the alarm's Alarm_Time_Group_Number if
+ * none exists yet.
+ *
+ * @return 0 on success, EINVAL for a non-positive ID or period, EEXIST if an
+ * alarm with the same ID exists, or an error from thread creation.
+ */
+int alarm_scheduler_insert(alarm_scheduler_t *scheduler, int alarm_id,
+                           int seconds, const char *message);
+
+/**
+ * @brief Replace the period and message of an existing alarm.
+ *
+ * If the alarm moves to another Alarm_Time_Group_Number, the display thread
+ * of the old group is terminated and joined when it has no alarms left.
+ *
+ * @return 0 on success, EINVAL for a non-positive ID or period, ENOENT if no
+ * alarm has the given ID, or an error from thread creation.
+ */
+int alarm_scheduler_replace(alarm_scheduler_t *scheduler, int alarm_id,
+                            int seconds, const char *message);
+
+/**
+ * @brief Cancel the alarm with the given ID.
+ *
+ * The display thread of the alarm's group is terminated and joined when it
+ * has no alarms left.
+ *
+ * @return 0 on success, EINVAL for a non-positive ID, ENOENT if no alarm has
+ * the given ID.
+ */
+int alarm_scheduler_cancel(alarm_scheduler_t *scheduler, int alarm_id);
+
+/**
+ * @brief Stop all display threads and release the scheduler.
+ *
+ * Joins every display thread of the instance, so no library code runs on
+ * behalf of the scheduler once this returns. No events are reported for the
+ * alarms and threads discarded here.
+ */
+void alarm_scheduler_destroy(alarm_scheduler_t *scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALARM_SCHEDULER_H
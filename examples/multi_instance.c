@@ -0,0 +1,145 @@
+#define _GNU_SOURCE // sched_getcpu and cpu_set_t
+#include "alarm_scheduler.h"
+#include "errors.h"
+#include <sched.h>
+
+/*
+ * multi_instance.c
+ *
+ *Example driver for the scheduler library. It runs two independent
+ *schedulers side by side, each with its display threads pinned to its own
+ *CPU, and exercises insert, replace, cancel and destroy on both of them.
+ *Displayed alarms report the CPU they were displayed on. When the process
+ *may only run on one CPU, both instances share it.
+ *
+ *Build and run with `make example && ./examples/multi_instance`.
+ */
+
+// Print one line per event, prefixed with the instance name
+static void print_event(const alarm_event_t *event, void *user_data) {
+  const char *name = (const char *)user_data;
+
+  switch (event->type) {
+  case ALARM_EVENT_INSERTED:
+    printf("[%s] Alarm(%d) Inserted: %d %s\n", name, event->alarm_id,
+           event->seconds, event->message);
+    break;
+  case ALARM_EVENT_REPLACED:
+    printf("[%s] Alarm(%d) Replaced: %d %s\n", name, event->alarm_id,
+           event->seconds, event->message);
+    break;
+  case ALARM_EVENT_CANCELED:
+    printf("[%s] Alarm(%d) Canceled: %d %s\n", name, event->alarm_id,
+           event->seconds, event->message);
+    break;
+  case ALARM_EVENT_DISPLAYED:
+    // Runs on the display thread, so this is the CPU it is pinned to
+    printf("[%s] Alarm(%d) Displayed for Alarm_Time_Group_Number %d on CPU "
+           "%d: %s\n",
+           name, event->alarm_id, event->alarm_group, sched_getcpu(),
+           event->message);
+    break;
+  case ALARM_EVENT_THREAD_CREATED:
+    printf("[%s] Created Display Alarm Thread for Alarm_Time_Group_Number "
+           "%d\n",
+           name, event->alarm_group);
+    break;
+  case ALARM_EVENT_THREAD_TERMINATED:
+    printf("[%s] Display Alarm Thread for Alarm_Time_Group_Number %d "
+           "Terminated\n",
+           name, event->alarm_group);
+    break;
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+  int status;
+  int cpu;
+  int cpus[2] = {-1, -1};
+  cpu_set_t allowed;
+  alarm_scheduler_t *scheduler_a, *scheduler_b;
+
+  // Pick the first two CPUs the process may run on, one per instance
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+    errno_abort("Get CPU affinity");
+  }
+  for (cpu = 0; cpu < CPU_SETSIZE && cpus[1] < 0; cpu++) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      if (cpus[0] < 0) {
+        cpus[0] = cpu;
+      } else {
+        cpus[1] = cpu;
+      }
+    }
+  }
+  if (cpus[1] < 0) {
+    printf("Only CPU %d is available, both instances share it\n", cpus[0]);
+    cpus[1] = cpus[0];
+  }
+
+  alarm_scheduler_options_t options_a = {print_event, "A", &cpus[0], 1};
+  alarm_scheduler_options_t options_b = {print_event, "B", &cpus[1], 1};
+
+  status = alarm_scheduler_create(&scheduler_a, &options_a);
+  if (status != 0) {
+    err_abort(status, "Create scheduler A");
+  }
+  status = alarm_scheduler_create(&scheduler_b, &options_b);
+  if (status != 0) {
+    err_abort(status, "Create scheduler B");
+  }
+  printf("Scheduler A pinned to CPU %d, scheduler B pinned to CPU %d\n",
+         cpus[0], cpus[1]);
+
+  // The same alarm IDs are independent in each instance
+  status = alarm_scheduler_insert(scheduler_a, 1, 1, "A_Message_1");
+  if (status != 0) {
+    err_abort(status, "Insert alarm into A");
+  }
+  status = alarm_scheduler_insert(scheduler_a, 2, 6, "A_Message_2");
+  if (status != 0) {
+    err_abort(status, "Insert alarm into A");
+  }
+  status = alarm_scheduler_insert(scheduler_b, 1, 2, "B_Message_1");
+  if (status != 0) {
+    err_abort(status, "Insert alarm into B");
+  }
+  status = alarm_scheduler_insert(scheduler_b, 2, 8, "B_Message_2");
+  if (status != 0) {
+    err_abort(status, "Insert alarm into B");
+  }
+  sleep(3);
+
+  // Move alarm 1 of A to another group, its old display thread terminates
+  status = alarm_scheduler_replace(scheduler_a, 1, 11, "A_Replaced_1");
+  if (status != 0) {
+    err_abort(status, "Replace alarm in A");
+  }
+
+  // Replace alarm 1 of B within the same group, its thread is kept
+  status = alarm_scheduler_replace(scheduler_b, 1, 4, "B_Replaced_1");
+  if (status != 0) {
+    err_abort(status, "Replace alarm in B");
+  }
+
+  // Cancel alarm 2 of B, the last one of its group
+  status = alarm_scheduler_cancel(scheduler_b, 2);
+  if (status != 0) {
+    err_abort(status, "Cancel alarm in B");
+  }
+  sleep(4);
+
+  // Cancel alarm 2 of A once it has been displayed
+  status = alarm_scheduler_cancel(scheduler_a, 2);
+  if (status != 0) {
+    err_abort(status, "Cancel alarm in A");
+  }
+
+  // Both instances are still running; destroy joins their display threads
+  alarm_scheduler_destroy(scheduler_a);
+  alarm_scheduler_destroy(scheduler_b);
+  printf("Both schedulers destroyed\n");
+
+  return 0;
+}